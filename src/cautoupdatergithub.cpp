@@ -7,9 +7,12 @@
 
 #include <QCollator>
 #include <QCoreApplication>
+#include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <algorithm>
 #include <utility>
 
 #include "updateinstaller.hpp"
@@ -26,6 +29,78 @@ static const auto naturalSortQstringComparator = [](const QString& l,
                           qToStringViewIgnoringNull(r)) < 0;
 };
 
+// Hedging tuning. The hedge deadline of an endpoint is the given percentile of
+// its recent time-to-first-byte samples, clamped to [min, max]; until enough
+// samples are collected the default is used. A failed endpoint is ranked
+// behind the healthy ones until its failures expire.
+static constexpr size_t MaxLatencySamples = 32;
+static constexpr size_t MinSamplesForPercentile = 4;
+static constexpr double HedgePercentile = 0.9;
+static constexpr qint64 DefaultHedgeDelayMs = 1000;
+static constexpr qint64 MinHedgeDelayMs = 50;
+static constexpr qint64 MaxHedgeDelayMs = 10000;
+static constexpr qint64 FailureExpiryMs = 60000;
+
+static bool failuresExpired(const QElapsedTimer& sinceLastFailure) {
+  return !sinceLastFailure.isValid() ||
+         sinceLastFailure.hasExpired(FailureExpiryMs);
+}
+
+static qint64 latencyPercentile(std::vector<qint64> samples,
+                                double percentile) {
+  assert(!samples.empty());
+  const auto index = static_cast<size_t>(
+      percentile * static_cast<double>(samples.size() - 1) + 0.5);
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+// The access token is a GitHub credential; mirrors never get to see it.
+static bool isGithubApiUrl(const QUrl& url) {
+  static const QUrl githubApiUrl(QStringLiteral("https://api.github.com/"));
+  return url.scheme() == githubApiUrl.scheme() &&
+         url.host() == githubApiUrl.host() &&
+         url.port(443) == githubApiUrl.port(443);
+}
+
+// Appends the valid http(s) entries of `endpoints` to `out`, each ending with
+// a slash. Anything else is skipped with a warning.
+static void appendValidEndpoints(const QStringList& endpoints,
+                                 QStringList& out) {
+  for (QString endpoint : endpoints) {
+    const QUrl url(endpoint, QUrl::StrictMode);
+    if (!url.isValid() || url.host().isEmpty() ||
+        (url.scheme() != QLatin1String("https") &&
+         url.scheme() != QLatin1String("http"))) {
+      qWarning() << "Ignoring invalid mirror endpoint" << endpoint;
+      continue;
+    }
+
+    if (!endpoint.endsWith('/')) endpoint.append('/');
+    out.push_back(endpoint);
+  }
+}
+
+struct CAutoUpdaterGithub::HedgedRequest {
+  struct Attempt {
+    QString endpoint;
+    QNetworkReply* reply = nullptr;
+    QElapsedTimer elapsed;
+  };
+
+  std::vector<Candidate> candidates;
+  EndpointStatsMap* stats = nullptr;
+  size_t nextCandidate = 0;
+  std::vector<Attempt> inFlight;
+  QTimer* hedgeTimer = nullptr;
+  bool done = false;
+  QString lastError;
+
+  std::function<QNetworkRequest(const QUrl&)> makeRequest;
+  std::function<void(QNetworkReply*)> onWinner;
+  std::function<void(const QString&)> onFailure;
+};
+
 CAutoUpdaterGithub::CAutoUpdaterGithub(
     QObject* parent, QString githubRepositoryName, QString currentVersionString,
     QString fileNameTag, QString accessToken, bool allowPreRelease,
@@ -50,25 +125,49 @@ void CAutoUpdaterGithub::setUpdateStatusListener(
   _listener = listener;
 }
 
+void CAutoUpdaterGithub::setMirrors(const QStringList& metadataEndpoints,
+                                    const QStringList& assetEndpoints) {
+  QStringList validMetadataEndpoints;
+  appendValidEndpoints(metadataEndpoints, validMetadataEndpoints);
+  if (!validMetadataEndpoints.isEmpty())
+    _metadataEndpoints = validMetadataEndpoints;
+
+  QStringList validAssetEndpoints;
+  appendValidEndpoints(assetEndpoints, validAssetEndpoints);
+  if (!validAssetEndpoints.isEmpty()) _assetEndpoints = validAssetEndpoints;
+}
+
 void CAutoUpdaterGithub::checkForUpdates() {
-  QNetworkRequest request;
-  request.setUrl(QUrl(QString(RepoUrl.data()) + _repoName));
-  request.setRawHeader("Accept", "application/vnd.github+json");
-
-  // set access token if enabled:
-  if (!_accessToken.isEmpty()) {
-    QString tokenValue = "token " + _accessToken;
-    request.setRawHeader("Authorization", tokenValue.toUtf8());
-  }
+  auto makeRequest = [this](const QUrl& url) {
+    QNetworkRequest request(url);
+    request.setRawHeader("Accept", "application/vnd.github+json");
+
+    // set access token if enabled:
+    if (!_accessToken.isEmpty() && isGithubApiUrl(url)) {
+      QString tokenValue = "token " + _accessToken;
+      request.setRawHeader("Authorization", tokenValue.toUtf8());
+    }
 
-  QNetworkReply* reply = _networkManager->get(request);
-  if (!reply) {
-    if (_listener) _listener->onUpdateError("Network request rejected.");
-    return;
-  }
+    return request;
+  };
 
-  connect(reply, &QNetworkReply::finished, this,
-          &CAutoUpdaterGithub::updateCheckRequestFinished);
+  startHedgedRequest(rankCandidates(_metadataEndpoints, _repoName,
+                                    _metadataEndpointStats),
+                     _metadataEndpointStats, std::move(makeRequest),
+                     [this](QNetworkReply* reply) {
+                       if (reply->isFinished()) {
+                         updateCheckRequestFinished(reply);
+                         return;
+                       }
+
+                       connect(reply, &QNetworkReply::finished, this,
+                               [this, reply] {
+                                 updateCheckRequestFinished(reply);
+                               });
+                     },
+                     [this](const QString& errorMessage) {
+                       if (_listener) _listener->onUpdateError(errorMessage);
+                     });
 }
 
 void CAutoUpdaterGithub::downloadAndInstallUpdate(const QString& updateUrl,
@@ -83,40 +182,290 @@ void CAutoUpdaterGithub::downloadAndInstallUpdate(const QString& updateUrl,
     return;
   }
 
-  QNetworkRequest request((QUrl(updateUrl)));
+  // The changelog URLs are built from the first asset endpoint; any other
+  // configured endpoint serves the same path. Foreign URLs are used as is,
+  // with their origin as the statistics key.
+  std::vector<Candidate> candidates;
+  const auto endpoint =
+      std::find_if(_assetEndpoints.cbegin(), _assetEndpoints.cend(),
+                   [&](const QString& e) { return updateUrl.startsWith(e); });
+  if (endpoint != _assetEndpoints.cend())
+    candidates = rankCandidates(_assetEndpoints,
+                                updateUrl.mid(endpoint->size()),
+                                _assetEndpointStats);
+  else
+    candidates.emplace_back(
+        QUrl(updateUrl)
+            .adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath |
+                      QUrl::RemoveQuery | QUrl::RemoveFragment)
+            .toString(),
+        QUrl(updateUrl));
+
+  auto makeRequest = [this](const QUrl& url) {
+    QNetworkRequest request(url);
+
+    // set access token if enabled:
+    if (!_accessToken.isEmpty() && isGithubApiUrl(url)) {
+      QString tokenValue = "token " + _accessToken;
+      request.setRawHeader("Authorization", tokenValue.toUtf8());
+    }
+
+    request.setRawHeader("Accept", "application/octet-stream");
+    request.setSslConfiguration(
+        QSslConfiguration::defaultConfiguration());  // HTTPS
+    request.setMaximumRedirectsAllowed(5);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                         QNetworkRequest::NoLessSafeRedirectPolicy);
+    return request;
+  };
+
+  const auto hedged = startHedgedRequest(
+      std::move(candidates), _assetEndpointStats, std::move(makeRequest),
+      [this](QNetworkReply* reply) {
+        onNewDataDownloaded(reply);
+        if (reply->isFinished()) {
+          updateDownloaded(reply);
+          return;
+        }
+
+        connect(reply, &QNetworkReply::readyRead, this,
+                [this, reply] { onNewDataDownloaded(reply); });
+        connect(reply, &QNetworkReply::downloadProgress, this,
+                &CAutoUpdaterGithub::onDownloadProgress);
+        connect(reply, &QNetworkReply::finished, this,
+                [this, reply] { updateDownloaded(reply); });
+        connect(this, &CAutoUpdaterGithub::cancelDownload, reply,
+                &QNetworkReply::abort);
+      },
+      [this](const QString& errorMessage) {
+        _downloadedBinaryFile.close();
+        if (_listener) _listener->onUpdateError(errorMessage);
+      });
+
+  // Until a winner is picked, cancelling aborts every outstanding attempt;
+  // afterwards the winner's own connection above takes over.
+  connect(this, &CAutoUpdaterGithub::cancelDownload, hedged->hedgeTimer,
+          [hedged] { abortHedgedRequest(hedged); });
+}
+
+std::vector<CAutoUpdaterGithub::Candidate> CAutoUpdaterGithub::rankCandidates(
+    const QStringList& endpoints, const QString& path,
+    const EndpointStatsMap& stats) {
+  std::vector<Candidate> candidates;
+  for (const auto& endpoint : endpoints)
+    candidates.emplace_back(endpoint, QUrl(endpoint + path));
+
+  // Healthy endpoints with the lowest median time-to-first-byte go first.
+  // Endpoints without samples keep their configured order behind them. Recent
+  // failures demote an endpoint; once they expire, its samples rank it again.
+  auto rank = [&stats](const Candidate& candidate) {
+    const auto entry = stats.find(candidate.first);
+    if (entry == stats.end()) return std::make_pair(0, MaxHedgeDelayMs);
+
+    const auto& samples = entry->second.firstByteLatenciesMs;
+    const qint64 median =
+        samples.empty()
+            ? MaxHedgeDelayMs
+            : latencyPercentile({samples.begin(), samples.end()}, 0.5);
+    const int failures = failuresExpired(entry->second.sinceLastFailure)
+                             ? 0
+                             : entry->second.consecutiveFailures;
+    return std::make_pair(failures, median);
+  };
+
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [&](const Candidate& l, const Candidate& r) {
+                     return rank(l) < rank(r);
+                   });
+  return candidates;
+}
+
+qint64 CAutoUpdaterGithub::hedgeDelayMs(const EndpointStatsMap& stats,
+                                        const QString& endpoint) {
+  const auto entry = stats.find(endpoint);
+  if (entry == stats.end() ||
+      entry->second.firstByteLatenciesMs.size() < MinSamplesForPercentile)
+    return DefaultHedgeDelayMs;
+
+  const auto& samples = entry->second.firstByteLatenciesMs;
+  return std::clamp(
+      latencyPercentile({samples.begin(), samples.end()}, HedgePercentile),
+      MinHedgeDelayMs, MaxHedgeDelayMs);
+}
+
+void CAutoUpdaterGithub::recordLatency(EndpointStatsMap& stats,
+                                       const QString& endpoint,
+                                       qint64 latencyMs) {
+  auto& entry = stats[endpoint];
+  entry.consecutiveFailures = 0;
+  entry.firstByteLatenciesMs.push_back(latencyMs);
+  if (entry.firstByteLatenciesMs.size() > MaxLatencySamples)
+    entry.firstByteLatenciesMs.pop_front();
+}
+
+void CAutoUpdaterGithub::recordLowerBound(EndpointStatsMap& stats,
+                                          const QString& endpoint,
+                                          qint64 latencyMs) {
+  // The endpoint has not answered within `latencyMs`, so any faster sample
+  // describes how it used to behave rather than how it behaves now.
+  auto& samples = stats[endpoint].firstByteLatenciesMs;
+  const auto isStale = [=](qint64 sample) { return sample < latencyMs; };
+  samples.erase(std::remove_if(samples.begin(), samples.end(), isStale),
+                samples.end());
+  samples.push_back(latencyMs);
+  if (samples.size() > MaxLatencySamples) samples.pop_front();
+}
+
+void CAutoUpdaterGithub::recordFailure(EndpointStatsMap& stats,
+                                       const QString& endpoint) {
+  auto& entry = stats[endpoint];
+  if (failuresExpired(entry.sinceLastFailure)) entry.consecutiveFailures = 0;
+  ++entry.consecutiveFailures;
+  entry.sinceLastFailure.start();
+}
 
-  // set access token if enabled:
-  if (!_accessToken.isEmpty()) {
-    QString tokenValue = "token " + _accessToken;
-    request.setRawHeader("Authorization", tokenValue.toUtf8());
+std::shared_ptr<CAutoUpdaterGithub::HedgedRequest>
+CAutoUpdaterGithub::startHedgedRequest(
+    std::vector<Candidate> candidates, EndpointStatsMap& stats,
+    std::function<QNetworkRequest(const QUrl&)> makeRequest,
+    std::function<void(QNetworkReply*)> onWinner,
+    std::function<void(const QString&)> onFailure) {
+  assert(!candidates.empty());
+
+  auto hedged = std::make_shared<HedgedRequest>();
+  hedged->candidates = std::move(candidates);
+  hedged->stats = &stats;
+  hedged->makeRequest = std::move(makeRequest);
+  hedged->onWinner = std::move(onWinner);
+  hedged->onFailure = std::move(onFailure);
+
+  hedged->hedgeTimer = new QTimer(this);
+  hedged->hedgeTimer->setSingleShot(true);
+  connect(hedged->hedgeTimer, &QTimer::timeout, this,
+          [this, hedged] { launchNextAttempt(hedged); });
+
+  launchNextAttempt(hedged);
+  return hedged;
+}
+
+void CAutoUpdaterGithub::abortHedgedRequest(
+    const std::shared_ptr<HedgedRequest>& hedged) {
+  if (hedged->done) return;
+
+  // Aborting the outstanding attempts fails them one by one, which ends the
+  // request with the "canceled" error once the last one is gone.
+  hedged->nextCandidate = hedged->candidates.size();
+  hedged->hedgeTimer->stop();
+  const auto inFlight = hedged->inFlight;
+  for (const auto& attempt : inFlight) attempt.reply->abort();
+}
+
+void CAutoUpdaterGithub::launchNextAttempt(
+    const std::shared_ptr<HedgedRequest>& hedged) {
+  if (hedged->done) return;
+
+  if (hedged->nextCandidate >= hedged->candidates.size()) {
+    if (!hedged->inFlight.empty()) return;
+
+    hedged->done = true;
+    hedged->hedgeTimer->deleteLater();
+    hedged->onFailure(hedged->lastError.isEmpty()
+                          ? QString("Network request rejected.")
+                          : hedged->lastError);
+    return;
   }
 
-  request.setRawHeader("Accept", "application/octet-stream");
-  request.setSslConfiguration(
-      QSslConfiguration::defaultConfiguration());  // HTTPS
-  request.setMaximumRedirectsAllowed(5);
-  request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
-                       QNetworkRequest::NoLessSafeRedirectPolicy);
-  QNetworkReply* reply = _networkManager->get(request);
+  const auto& [endpoint, url] = hedged->candidates[hedged->nextCandidate++];
+  QNetworkReply* reply = _networkManager->get(hedged->makeRequest(url));
   if (!reply) {
-    if (_listener) _listener->onUpdateError("Network request rejected.");
+    hedged->lastError = "Network request rejected.";
+    recordFailure(*hedged->stats, endpoint);
+    launchNextAttempt(hedged);
     return;
   }
 
+  HedgedRequest::Attempt attempt;
+  attempt.endpoint = endpoint;
+  attempt.reply = reply;
+  attempt.elapsed.start();
+  hedged->inFlight.push_back(std::move(attempt));
+
   connect(reply, &QNetworkReply::readyRead, this,
-          &CAutoUpdaterGithub::onNewDataDownloaded);
-  connect(reply, &QNetworkReply::downloadProgress, this,
-          &CAutoUpdaterGithub::onDownloadProgress);
+          [this, hedged, reply] { onAttemptFirstByte(hedged, reply); });
   connect(reply, &QNetworkReply::finished, this,
-          &CAutoUpdaterGithub::updateDownloaded, Qt::UniqueConnection);
-  connect(this, &CAutoUpdaterGithub::cancelDownload, reply,
-          &QNetworkReply::abort);
+          [this, hedged, reply] { onAttemptFinishedEarly(hedged, reply); });
+
+  if (hedged->nextCandidate < hedged->candidates.size())
+    hedged->hedgeTimer->start(
+        static_cast<int>(hedgeDelayMs(*hedged->stats, endpoint)));
 }
 
-void CAutoUpdaterGithub::updateCheckRequestFinished() {
-  auto* reply = qobject_cast<QNetworkReply*>(sender());
-  if (!reply) return;
+void CAutoUpdaterGithub::onAttemptFirstByte(
+    const std::shared_ptr<HedgedRequest>& hedged, QNetworkReply* reply) {
+  if (hedged->done) return;
+
+  // An HTTP error body is not a usable first byte; the attempt fails over once
+  // it finishes.
+  const auto httpStatus =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+  if (httpStatus.isValid() && httpStatus.toInt() >= 400) return;
+
+  hedged->done = true;
+  hedged->hedgeTimer->stop();
+  hedged->hedgeTimer->deleteLater();
+
+  // Only the winner yields a real time-to-first-byte sample. Losers launched
+  // before the winner (the attempts are kept in launch order) have been waiting
+  // at least as long, which bounds their latency from below. Losers launched
+  // after it may have had no chance to answer and are not recorded.
+  bool winnerSeen = false;
+  for (auto& attempt : hedged->inFlight) {
+    attempt.reply->disconnect(this);
+    if (attempt.reply == reply) {
+      winnerSeen = true;
+      recordLatency(*hedged->stats, attempt.endpoint,
+                    attempt.elapsed.elapsed());
+      continue;
+    }
+
+    if (!winnerSeen)
+      recordLowerBound(*hedged->stats, attempt.endpoint,
+                       attempt.elapsed.elapsed());
+
+    attempt.reply->abort();
+    attempt.reply->deleteLater();
+  }
+  hedged->inFlight.clear();
 
+  hedged->onWinner(reply);
+}
+
+void CAutoUpdaterGithub::onAttemptFinishedEarly(
+    const std::shared_ptr<HedgedRequest>& hedged, QNetworkReply* reply) {
+  // A successful reply with an empty body never emits readyRead.
+  if (reply->error() == QNetworkReply::NoError) {
+    onAttemptFirstByte(hedged, reply);
+    return;
+  }
+
+  const auto attempt = std::find_if(
+      hedged->inFlight.begin(), hedged->inFlight.end(),
+      [reply](const HedgedRequest::Attempt& a) { return a.reply == reply; });
+  if (attempt == hedged->inFlight.end()) return;
+
+  // Fail over to the next endpoint right away instead of waiting for the
+  // hedge deadline.
+  if (reply->error() != QNetworkReply::OperationCanceledError)
+    recordFailure(*hedged->stats, attempt->endpoint);
+  hedged->lastError = reply->errorString();
+  hedged->inFlight.erase(attempt);
+  reply->deleteLater();
+
+  hedged->hedgeTimer->stop();
+  launchNextAttempt(hedged);
+}
+
+void CAutoUpdaterGithub::updateCheckRequestFinished(QNetworkReply* reply) {
   QSharedPointer<QNetworkReply> replyPtr{reply, &QNetworkReply::deleteLater};
 
   if (replyPtr->error() != QNetworkReply::NoError) {
@@ -195,7 +544,7 @@ void CAutoUpdaterGithub::updateCheckRequestFinished() {
         // Generate url link:
         const auto assetIdUrl = QVariant(assetObject["id"].toInt()).toString();
 
-        url = QString(RepoUrl.data())
+        url = QString(_assetEndpoints.front())
             .append(_repoName)
             .append("/")
             .append("assets")
@@ -246,14 +595,9 @@ void CAutoUpdaterGithub::updateCheckRequestFinished() {
   if (_listener) _listener->onUpdateAvailable(changelog);
 }
 
-void CAutoUpdaterGithub::updateDownloaded() {
+void CAutoUpdaterGithub::updateDownloaded(QNetworkReply* reply) {
   _downloadedBinaryFile.close();
 
-  auto* reply = qobject_cast<QNetworkReply*>(sender());
-  if (!reply) {
-    return;
-  }
-
   QSharedPointer<QNetworkReply> replyPtr{reply, &QNetworkReply::deleteLater};
 
   if (replyPtr->error() != QNetworkReply::NoError) {
@@ -285,9 +629,6 @@ void CAutoUpdaterGithub::onDownloadProgress(qint64 bytesReceived,
   }
 }
 
-void CAutoUpdaterGithub::onNewDataDownloaded() {
-  auto* reply = qobject_cast<QNetworkReply*>(sender());
-  if (!reply) return;
-
+void CAutoUpdaterGithub::onNewDataDownloaded(QNetworkReply* reply) {
   _downloadedBinaryFile.write(reply->readAll());
 }
@@ -1,10 +1,16 @@
 #pragma once
 #include <QFile>
+#include <QElapsedTimer>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <deque>
 #include <functional>
+#include <map>
+#include <memory>
 #include <qcollator.h>
 #include <vector>
 #include <qversionnumber.h>
@@ -68,6 +74,17 @@ class CAutoUpdaterGithub final : public QObject {
 
   Q_SLOT void setUpdateStatusListener(UpdateStatusListener* listener);
 
+  // Ordered lists of equivalent API base URLs (same layout as RepoUrl, e. g.
+  // "https://api.github.com/repos/"). The first entry is preferred until
+  // latency statistics say otherwise. Requests are hedged: if an endpoint has
+  // not produced its first byte within a percentile-based deadline, the next
+  // one is queried as well and the slower requests are aborted. Entries that
+  // are not valid http(s) URLs with a host are skipped; a list without any
+  // valid entry keeps the current endpoints. The access token is only sent to
+  // https://api.github.com, never to other mirrors.
+  Q_SLOT void setMirrors(const QStringList& metadataEndpoints,
+                         const QStringList& assetEndpoints);
+
   Q_SLOT void checkForUpdates();
   Q_SLOT void downloadAndInstallUpdate(const QString& updateUrl,
                                        const QString& filename);
@@ -75,10 +92,47 @@ class CAutoUpdaterGithub final : public QObject {
   Q_SIGNAL void cancelDownload();
 
  private:
-  void updateCheckRequestFinished();
-  void updateDownloaded();
+  struct HedgedRequest;
+
+  struct EndpointStats {
+    std::deque<qint64> firstByteLatenciesMs;  // Most recent samples only
+    int consecutiveFailures = 0;
+    QElapsedTimer sinceLastFailure;  // Failures expire, see rankCandidates()
+  };
+
+  // Keyed by endpoint. Metadata and asset requests are kept apart: a small
+  // JSON call and a redirected binary download have unrelated latencies.
+  using EndpointStatsMap = std::map<QString, EndpointStats>;
+
+  using Candidate = std::pair<QString /* endpoint */, QUrl>;
+
+  static std::vector<Candidate> rankCandidates(const QStringList& endpoints,
+                                               const QString& path,
+                                               const EndpointStatsMap& stats);
+  static qint64 hedgeDelayMs(const EndpointStatsMap& stats,
+                             const QString& endpoint);
+  static void recordLatency(EndpointStatsMap& stats, const QString& endpoint,
+                            qint64 latencyMs);
+  static void recordLowerBound(EndpointStatsMap& stats,
+                               const QString& endpoint, qint64 latencyMs);
+  static void recordFailure(EndpointStatsMap& stats, const QString& endpoint);
+
+  std::shared_ptr<HedgedRequest> startHedgedRequest(
+      std::vector<Candidate> candidates, EndpointStatsMap& stats,
+      std::function<QNetworkRequest(const QUrl&)> makeRequest,
+      std::function<void(QNetworkReply*)> onWinner,
+      std::function<void(const QString&)> onFailure);
+  static void abortHedgedRequest(const std::shared_ptr<HedgedRequest>& hedged);
+  void launchNextAttempt(const std::shared_ptr<HedgedRequest>& hedged);
+  void onAttemptFirstByte(const std::shared_ptr<HedgedRequest>& hedged,
+                          QNetworkReply* reply);
+  void onAttemptFinishedEarly(const std::shared_ptr<HedgedRequest>& hedged,
+                              QNetworkReply* reply);
+
+  void updateCheckRequestFinished(QNetworkReply* reply);
+  void updateDownloaded(QNetworkReply* reply);
   void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
-  void onNewDataDownloaded();
+  void onNewDataDownloaded(QNetworkReply* reply);
 
  private:
   QFile _downloadedBinaryFile;
@@ -92,6 +146,11 @@ class CAutoUpdaterGithub final : public QObject {
 
   static constexpr std::string_view RepoUrl = "https://api.github.com/repos/";
 
+  QStringList _metadataEndpoints{QString(RepoUrl.data())};
+  QStringList _assetEndpoints{QString(RepoUrl.data())};
+  EndpointStatsMap _metadataEndpointStats;
+  EndpointStatsMap _assetEndpointStats;
+
   UpdateStatusListener* _listener = nullptr;
 
   QNetworkAccessManager* _networkManager;
@@ -0,0 +1,31 @@
+TARGET = tst_cautoupdatergithub
+TEMPLATE = app
+
+QT = core network testlib
+# The Windows and macOS installers use QApplication
+win* | mac*:QT += widgets gui
+
+CONFIG += testcase console strict_c++ c++latest
+CONFIG -= app_bundle
+
+# Only the updater core is under test
+CONFIG += updater_without_widgets
+
+mac* | linux* | freebsd{
+	QMAKE_CXXFLAGS_WARN_ON = -Wall
+}
+
+INCLUDEPATH += ../src
+
+HEADERS += \
+	../src/cautoupdatergithub.h \
+	../src/updateinstaller.hpp
+
+SOURCES += \
+	tst_cautoupdatergithub.cpp \
+	../src/cautoupdatergithub.cpp
+
+win*:SOURCES += ../src/updateinstaller_win.cpp
+mac*:SOURCES += ../src/updateinstaller_mac.cpp
+linux*:SOURCES += ../src/updateinstaller_linux.cpp
+freebsd:SOURCES += ../src/updateinstaller_freebsd.cpp
@@ -0,0 +1,335 @@
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtTest>
+
+#include <algorithm>
+
+#include "cautoupdatergithub.h"
+
+// A local stand-in for the GitHub API: answers every request with the same
+// release JSON (which doubles as the asset body) after an injected delay.
+class DelayedMirror final : public QObject {
+  Q_OBJECT
+
+ public:
+  DelayedMirror(int delayMs, int& connectionSequence)
+      : delayMs(delayMs), _connectionSequence(connectionSequence) {
+    connect(&_server, &QTcpServer::newConnection, this,
+            &DelayedMirror::onNewConnection);
+    if (!_server.listen(QHostAddress::LocalHost))
+      qFatal("Failed to start a local mirror: %s",
+             qPrintable(_server.errorString()));
+  }
+
+  QString endpoint() const {
+    return QStringLiteral("http://127.0.0.1:%1/").arg(_server.serverPort());
+  }
+
+  // Apply to connections accepted from now on
+  int delayMs;
+  int status = 200;
+
+  // Global order in which the connections to all mirrors arrived
+  std::vector<int> connections;
+  std::vector<QByteArray> requestHeaders;
+  int answered = 0;
+  int aborted = 0;
+
+ private:
+  void onNewConnection() {
+    while (QTcpSocket* socket = _server.nextPendingConnection()) {
+      connections.push_back(_connectionSequence++);
+
+      auto request = std::make_shared<QByteArray>();
+      connect(socket, &QTcpSocket::readyRead, this, [this, socket, request] {
+        const bool complete = request->contains("\r\n\r\n");
+        request->append(socket->readAll());
+        if (!complete && request->contains("\r\n\r\n"))
+          requestHeaders.push_back(*request);
+      });
+
+      auto answeredThis = std::make_shared<bool>(false);
+      QTimer::singleShot(delayMs, socket, [this, socket, answeredThis] {
+        static const QByteArray body =
+            R"({"tag_name": "v0.1", "draft": false, "assets": []})";
+        socket->write("HTTP/1.1 " + QByteArray::number(status) +
+                      (status < 400 ? " OK" : " Error") +
+                      "\r\n"
+                      "Content-Type: application/json\r\n"
+                      "Connection: close\r\n"
+                      "Content-Length: " +
+                      QByteArray::number(body.size()) + "\r\n\r\n" + body);
+        *answeredThis = true;
+        ++answered;
+        socket->disconnectFromHost();
+      });
+      connect(socket, &QTcpSocket::disconnected, this,
+              [this, socket, answeredThis] {
+                if (!*answeredThis) ++aborted;
+                socket->deleteLater();
+              });
+    }
+  }
+
+ private:
+  QTcpServer _server;
+  int& _connectionSequence;
+};
+
+struct Listener final : CAutoUpdaterGithub::UpdateStatusListener {
+  void onUpdateAvailable(const CAutoUpdaterGithub::ChangeLog&) override {
+    ++checksCompleted;
+  }
+  void onUpdateDownloadProgress(float) override {}
+  void onUpdateDownloadFinished() override { ++downloadsFinished; }
+  void onUpdateError(const QString& errorMessage) override {
+    lastError = errorMessage;
+  }
+
+  int checksCompleted = 0;
+  int downloadsFinished = 0;
+  QString lastError;
+};
+
+class TestCAutoUpdaterGithub final : public QObject {
+  Q_OBJECT
+
+ private:
+  static constexpr int CheckTimeoutMs = 10000;
+
+  static QString updateFilename() {
+    return QStringLiteral("tst_cautoupdatergithub_update") +
+           UPDATE_FILE_EXTENSION;
+  }
+
+  static bool containsAuthorization(const DelayedMirror& mirror) {
+    const auto hasAuthorization = [](const QByteArray& headers) {
+      return headers.toLower().contains("\r\nauthorization:");
+    };
+    return std::any_of(mirror.requestHeaders.cbegin(),
+                       mirror.requestHeaders.cend(), hasAuthorization);
+  }
+
+  int _connectionSequence = 0;
+
+ private slots:
+  void hedgedCheckPicksFastestMirror() {
+    DelayedMirror slow(3000, _connectionSequence);
+    DelayedMirror fast(50, _connectionSequence);
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({slow.endpoint(), fast.endpoint()}, {});
+
+    // The slow mirror misses the default hedge deadline, the fast one is
+    // queried as well, wins, and the slow request gets aborted.
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 1, CheckTimeoutMs);
+    QVERIFY(listener.lastError.isEmpty());
+    QCOMPARE(fast.answered, 1);
+    QTRY_COMPARE_WITH_TIMEOUT(slow.aborted, 1, CheckTimeoutMs);
+    QCOMPARE(slow.answered, 0);
+
+    // Next time the fast mirror goes first and answers before any hedging.
+    const int nextConnection = _connectionSequence;
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 2, CheckTimeoutMs);
+    QCOMPARE(fast.connections.back(), nextConnection);
+    QCOMPARE(slow.connections.size(), size_t{1});
+  }
+
+  void hedgeLoserIsNotPromoted() {
+    // Answers shortly after the hedge deadline, before the hedge does.
+    DelayedMirror primary(1300, _connectionSequence);
+    DelayedMirror dead(60000, _connectionSequence);
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({primary.endpoint(), dead.endpoint()}, {});
+
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 1, CheckTimeoutMs);
+    QCOMPARE(primary.answered, 1);
+    QCOMPARE(dead.connections.size(), size_t{1});
+    QTRY_COMPARE_WITH_TIMEOUT(dead.aborted, 1, CheckTimeoutMs);
+
+    // The hedge was cut short by the winner, which says nothing about its
+    // latency, so the primary must still be queried first.
+    const int nextConnection = _connectionSequence;
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 2, CheckTimeoutMs);
+    QCOMPARE(primary.connections.back(), nextConnection);
+  }
+
+  void slowedDownMirrorLosesFirstPlace() {
+    DelayedMirror primary(20, _connectionSequence);
+    DelayedMirror backup(200, _connectionSequence);
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({primary.endpoint(), backup.endpoint()}, {});
+
+    // Enough fast samples for a percentile-based hedge deadline (~50 ms)
+    for (int check = 1; check <= 4; ++check) {
+      updater.checkForUpdates();
+      QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, check,
+                                CheckTimeoutMs);
+    }
+    QCOMPARE(primary.answered, 4);
+    QVERIFY(backup.connections.empty());
+
+    // The backup is started at the primary's own deadline, well before the
+    // 1 s default, and wins.
+    primary.delayMs = 3000;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 5, CheckTimeoutMs);
+    QVERIFY(elapsed.elapsed() < 800);
+    QCOMPARE(backup.answered, 1);
+    QTRY_COMPARE_WITH_TIMEOUT(primary.aborted, 1, CheckTimeoutMs);
+
+    // The primary's old fast samples must not keep it in first place.
+    const int nextConnection = _connectionSequence;
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 6, CheckTimeoutMs);
+    QCOMPARE(backup.connections.back(), nextConnection);
+  }
+
+  void invalidMirrorsAreSkipped() {
+    DelayedMirror mirror(0, _connectionSequence);
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({"", "ftp://127.0.0.1/", "not a url", mirror.endpoint()},
+                       {});
+
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 1, CheckTimeoutMs);
+    QVERIFY(listener.lastError.isEmpty());
+    QCOMPARE(mirror.connections.size(), size_t{1});
+  }
+
+  void failoverOnHttpErrorAndRefusedConnection() {
+    DelayedMirror failing(0, _connectionSequence);
+    failing.status = 500;
+    DelayedMirror backup(50, _connectionSequence);
+
+    QTcpServer closed;
+    QVERIFY(closed.listen(QHostAddress::LocalHost));
+    const QString refusedEndpoint =
+        QStringLiteral("http://127.0.0.1:%1/").arg(closed.serverPort());
+    closed.close();
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({refusedEndpoint, failing.endpoint(), backup.endpoint()},
+                       {});
+
+    // Errors fail over right away instead of waiting for the 1 s deadline.
+    QElapsedTimer elapsed;
+    elapsed.start();
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 1, CheckTimeoutMs);
+    QVERIFY(elapsed.elapsed() < 800);
+    QVERIFY(listener.lastError.isEmpty());
+    QCOMPARE(failing.answered, 1);
+    QCOMPARE(backup.answered, 1);
+  }
+
+  void accessTokenIsNotSentToMirrors() {
+    DelayedMirror mirror(0, _connectionSequence);
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0", "", "secret");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({mirror.endpoint()}, {});
+
+    updater.checkForUpdates();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 1, CheckTimeoutMs);
+    QCOMPARE(mirror.requestHeaders.size(), size_t{1});
+    QVERIFY(!containsAuthorization(mirror));
+  }
+
+  void hedgedDownloadPicksFastestAssetMirror() {
+#if defined _WIN32 || defined __APPLE__
+    QSKIP("A finished download launches the installer and exits");
+#endif
+    DelayedMirror slow(3000, _connectionSequence);
+    DelayedMirror fast(50, _connectionSequence);
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0", "", "secret");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({}, {slow.endpoint(), fast.endpoint()});
+
+    // The URL matches the first asset mirror, so its path is requested from
+    // every asset mirror.
+    updater.downloadAndInstallUpdate(slow.endpoint() + "owner/repo/assets/1",
+                                     updateFilename());
+    QTRY_COMPARE_WITH_TIMEOUT(listener.downloadsFinished, 1, CheckTimeoutMs);
+    QCOMPARE(fast.answered, 1);
+    QTRY_COMPARE_WITH_TIMEOUT(slow.aborted, 1, CheckTimeoutMs);
+    QCOMPARE(slow.answered, 0);
+
+    QCOMPARE(fast.requestHeaders.size(), size_t{1});
+    QVERIFY(fast.requestHeaders.front().startsWith(
+        "GET /owner/repo/assets/1 HTTP/1.1\r\n"));
+    QVERIFY(!containsAuthorization(slow));
+    QVERIFY(!containsAuthorization(fast));
+
+    QFile::remove(QDir::tempPath() + '/' + updateFilename());
+  }
+
+  void cancelDownloadBeforeWinner() {
+    DelayedMirror primary(60000, _connectionSequence);
+    DelayedMirror backup(60000, _connectionSequence);
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({}, {primary.endpoint(), backup.endpoint()});
+
+    updater.downloadAndInstallUpdate(
+        primary.endpoint() + "owner/repo/assets/1", updateFilename());
+    QTRY_COMPARE_WITH_TIMEOUT(primary.connections.size(), size_t{1},
+                              CheckTimeoutMs);
+
+    emit updater.cancelDownload();
+    QTRY_VERIFY_WITH_TIMEOUT(!listener.lastError.isEmpty(), CheckTimeoutMs);
+    QTRY_COMPARE_WITH_TIMEOUT(primary.aborted, 1, CheckTimeoutMs);
+    QCOMPARE(listener.downloadsFinished, 0);
+
+    // No hedge is started once the download has been cancelled.
+    QTest::qWait(1500);
+    QVERIFY(backup.connections.empty());
+
+    QFile::remove(QDir::tempPath() + '/' + updateFilename());
+  }
+
+  void cancelDownloadDoesNotAbortChecks() {
+    DelayedMirror mirror(200, _connectionSequence);
+
+    Listener listener;
+    CAutoUpdaterGithub updater(nullptr, "owner/repo", "1.0");
+    updater.setUpdateStatusListener(&listener);
+    updater.setMirrors({mirror.endpoint()}, {});
+
+    updater.checkForUpdates();
+    emit updater.cancelDownload();
+    QTRY_COMPARE_WITH_TIMEOUT(listener.checksCompleted, 1, CheckTimeoutMs);
+    QVERIFY(listener.lastError.isEmpty());
+  }
+};
+
+QTEST_GUILESS_MAIN(TestCAutoUpdaterGithub)
+#include "tst_cautoupdatergithub.moc"